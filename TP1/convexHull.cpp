@@ -6,7 +6,7 @@
 #include "DGtal/base/Common.h"
 #include "DGtal/helpers/StdDefs.h"
 
-#include <DGtal/geometry/tools/MelkmanConvexHull.h>
+#include "convexHull.h"
 
 #include "DGtal/io/boards/Board2D.h"
 ///////////////////////////////////////////////////////////////////////////////
@@ -24,12 +24,8 @@ int main()
         points.push_back(Point(rand()%100, rand()%100));
     }
 
-    // make a convex hull
-    typedef InHalfPlaneBySimple3x3Matrix<Z2i::Point, DGtal::int64_t> Functor;
-    Functor functor;
-    MelkmanConvexHull<Z2i::Point, Functor>  cvx( functor );
-    for (auto &p : points)
-        cvx.add(p);
+    // make a convex hull (Melkman only works on simple polylines, not on any point set)
+    std::vector<Z2i::Point> cvx = convexHull(points);
 
     // scan the CVX points and draw the edges
     Board2D aBoard;
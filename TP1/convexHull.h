@@ -0,0 +1,214 @@
+///////////////////////////////////////////////////////////////////////////////
+#ifndef CONVEX_HULL_H
+#define CONVEX_HULL_H
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
+///////////////////////////////////////////////////////////////////////////////
+
+// Convex hull of any set of digital points (Z2i::Point or any type with
+// operator[] and two int32 coordinates stored contiguously).
+//
+// - Akl-Toussaint: the points strictly inside the octagon of the extreme
+//   points in 8 directions are dropped, one chunk of points per thread;
+// - Andrew monotone chain on each chunk of the remaining points, in parallel;
+// - a last monotone chain on the vertices of the partial hulls.
+//
+// Predicates are exact in 64-bit integers as long as every coordinate lies
+// in ]-2^30, 2^30[. The hull is counterclockwise, without collinear vertices,
+// and starts from the leftmost then lowest point.
+
+namespace convexHullDetails
+{
+// (b - a) x (c - a), > 0 when c is on the left of (a, b)
+template <typename Point>
+inline int64_t cross(const Point &a, const Point &b, const Point &c)
+{
+  return (int64_t)(b[0] - a[0]) * (c[1] - a[1]) - (int64_t)(b[1] - a[1]) * (c[0] - a[0]);
+}
+
+template <typename Point>
+inline bool lexicographic(const Point &p, const Point &q)
+{
+  return p[0] < q[0] || (p[0] == q[0] && p[1] < q[1]);
+}
+
+// monotone chain on points sorted by lexicographic(), the first point is kept first
+template <typename Point>
+std::vector<Point> monotoneChain(const std::vector<Point> &sorted)
+{
+  if (sorted.size() < 3)
+  {
+    std::vector<Point> hull(sorted);
+    if (hull.size() == 2 && hull[0][0] == hull[1][0] && hull[0][1] == hull[1][1])
+      hull.pop_back();
+    return hull;
+  }
+  std::vector<Point> hull(2 * sorted.size());
+  size_t k = 0;
+  // lower chain, going right
+  for (size_t i = 0; i < sorted.size(); i++)
+  {
+    while (k >= 2 && cross(hull[k - 2], hull[k - 1], sorted[i]) <= 0)
+      k--;
+    hull[k++] = sorted[i];
+  }
+  // upper chain, going left
+  for (size_t i = sorted.size() - 1, t = k + 1; i > 0; i--)
+  {
+    while (k >= t && cross(hull[k - 2], hull[k - 1], sorted[i - 1]) <= 0)
+      k--;
+    hull[k++] = sorted[i - 1];
+  }
+  hull.resize(k - 1);
+  return hull;
+}
+
+// Run f(begin, end, threadIndex) on [0, size) cut in one slice per thread.
+template <typename F>
+void parallelSlices(size_t size, unsigned int nbThreads, F f)
+{
+  size_t slice = (size + nbThreads - 1) / nbThreads;
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < nbThreads; t++)
+  {
+    size_t begin = std::min(size, t * slice);
+    size_t end = std::min(size, begin + slice);
+    threads.push_back(std::thread(f, begin, end, t));
+  }
+  for (auto &t : threads)
+    t.join();
+}
+
+// counterclockwise octagon of the extreme points, consecutive duplicates removed
+template <typename Point>
+std::vector<Point> extremeOctagon(const std::vector<Point> &points, unsigned int nbThreads)
+{
+  // directions (1,-1), (1,0), (1,1), (0,1), (-1,1), (-1,0), (-1,-1), (0,-1)
+  // the tie is broken toward the next direction so that the octagon is convex
+  const int dx[8] = {1, 1, 1, 0, -1, -1, -1, 0};
+  const int dy[8] = {-1, 0, 1, 1, 1, 0, -1, -1};
+  std::vector<size_t> best(8 * nbThreads, 0);
+  auto better = [&](int d, const Point &p, const Point &q) {
+    int64_t vp = (int64_t)dx[d] * p[0] + (int64_t)dy[d] * p[1];
+    int64_t vq = (int64_t)dx[d] * q[0] + (int64_t)dy[d] * q[1];
+    if (vp != vq)
+      return vp > vq;
+    int n = (d + 1) % 8;
+    return (int64_t)dx[n] * p[0] + (int64_t)dy[n] * p[1] > (int64_t)dx[n] * q[0] + (int64_t)dy[n] * q[1];
+  };
+  parallelSlices(points.size(), nbThreads, [&](size_t begin, size_t end, unsigned int t) {
+    if (begin == end)
+      return;
+    for (int d = 0; d < 8; d++)
+      best[8 * t + d] = begin;
+    for (size_t i = begin + 1; i < end; i++)
+      for (int d = 0; d < 8; d++)
+        if (better(d, points[i], points[best[8 * t + d]]))
+          best[8 * t + d] = i;
+  });
+
+  std::vector<Point> octagon;
+  for (int d = 0; d < 8; d++)
+  {
+    size_t b = best[d];
+    for (unsigned int t = 1; t < nbThreads; t++)
+      if (better(d, points[best[8 * t + d]], points[b]))
+        b = best[8 * t + d];
+    const Point &p = points[b];
+    if (octagon.empty() || !(octagon.back()[0] == p[0] && octagon.back()[1] == p[1]))
+      octagon.push_back(p);
+  }
+  while (octagon.size() > 1 && octagon.back()[0] == octagon[0][0] && octagon.back()[1] == octagon[0][1])
+    octagon.pop_back();
+  return octagon;
+}
+
+// copy in out the points of [begin, end) not strictly inside the convex polygon
+template <typename Point>
+void prune(const std::vector<Point> &points, size_t begin, size_t end,
+           const std::vector<Point> &polygon, std::vector<Point> &out)
+{
+  const size_t n = polygon.size();
+  size_t i = begin;
+#ifdef __SSE4_1__
+  // two points per register: (x0, y0, x1, y1) as int32
+  static_assert(sizeof(Point) == 2 * sizeof(int32_t), "points must be two packed int32");
+  for (; i + 2 <= end; i += 2)
+  {
+    const __m128i v = _mm_loadu_si128((const __m128i *)&points[i]);
+    int inside = 3;
+    for (size_t e = 0; e < n && inside != 0; e++)
+    {
+      const Point &a = polygon[e];
+      const Point &b = polygon[(e + 1) % n];
+      // (u, w) = p - a on 32 bits, the products on 64 bits
+      const __m128i d = _mm_sub_epi32(v, _mm_setr_epi32(a[0], a[1], a[0], a[1]));
+      const __m128i uDy = _mm_mul_epi32(d, _mm_set1_epi32(b[1] - a[1]));
+      const __m128i wDx = _mm_mul_epi32(_mm_srli_si128(d, 4), _mm_set1_epi32(b[0] - a[0]));
+      // cross > 0 <=> uDy - wDx < 0
+      inside &= _mm_movemask_pd(_mm_castsi128_pd(_mm_sub_epi64(uDy, wDx)));
+    }
+    if ((inside & 1) == 0)
+      out.push_back(points[i]);
+    if ((inside & 2) == 0)
+      out.push_back(points[i + 1]);
+  }
+#endif
+  for (; i < end; i++)
+  {
+    bool inside = true;
+    for (size_t e = 0; e < n && inside; e++)
+      inside = cross(polygon[e], polygon[(e + 1) % n], points[i]) > 0;
+    if (!inside)
+      out.push_back(points[i]);
+  }
+}
+} // namespace convexHullDetails
+
+template <typename Point>
+std::vector<Point> convexHull(const std::vector<Point> &points, unsigned int nbThreads = 0)
+{
+  using namespace convexHullDetails;
+  if (nbThreads == 0)
+    nbThreads = std::max(1u, std::thread::hardware_concurrency());
+  // no thread for the small sets
+  if (points.size() < 100000)
+    nbThreads = 1;
+  if (points.empty())
+    return std::vector<Point>();
+
+  // Akl-Toussaint pruning
+  std::vector<Point> octagon = extremeOctagon(points, nbThreads);
+  std::vector<std::vector<Point>> kept(nbThreads);
+  if (octagon.size() >= 3)
+    parallelSlices(points.size(), nbThreads, [&](size_t begin, size_t end, unsigned int t) {
+      prune(points, begin, end, octagon, kept[t]);
+    });
+  else
+    kept[0] = points;
+
+  // one monotone chain per chunk
+  std::vector<std::vector<Point>> hulls(nbThreads);
+  parallelSlices(nbThreads, nbThreads, [&](size_t begin, size_t end, unsigned int) {
+    for (size_t t = begin; t < end; t++)
+    {
+      std::sort(kept[t].begin(), kept[t].end(), lexicographic<Point>);
+      hulls[t] = monotoneChain(kept[t]);
+    }
+  });
+
+  // hull of the partial hulls
+  std::vector<Point> vertices;
+  for (auto &h : hulls)
+    vertices.insert(vertices.end(), h.begin(), h.end());
+  std::sort(vertices.begin(), vertices.end(), lexicographic<Point>);
+  return monotoneChain(vertices);
+}
+
+#endif
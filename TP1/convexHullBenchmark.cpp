@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+///////////////////////////////////////////////////////////////////////////////
+#include "DGtal/base/Common.h"
+#include "DGtal/helpers/StdDefs.h"
+
+#include "convexHull.h"
+///////////////////////////////////////////////////////////////////////////////
+
+using namespace DGtal;
+using namespace Z2i;
+using namespace std;
+
+// reference: one monotone chain on all the points, without pruning nor threads
+vector<Z2i::Point> referenceHull(vector<Z2i::Point> points)
+{
+  sort(points.begin(), points.end(), convexHullDetails::lexicographic<Z2i::Point>);
+  return convexHullDetails::monotoneChain(points);
+}
+
+vector<Z2i::Point> randomPoints(long n, bool disk, mt19937 &rng)
+{
+  const int R = 1 << 20;
+  uniform_int_distribution<int> uniform(-R, R);
+  vector<Z2i::Point> points;
+  points.reserve(n);
+  while ((long)points.size() < n)
+  {
+    Z2i::Point p(uniform(rng), uniform(rng));
+    if (!disk || (int64_t)p[0] * p[0] + (int64_t)p[1] * p[1] <= (int64_t)R * R)
+      points.push_back(p);
+  }
+  return points;
+}
+
+int main(int argc, char **argv)
+{
+  // points from 10 to 10^maxExponent
+  int maxExponent = argc > 1 ? atoi(argv[1]) : 8;
+  // the reference is only run up to 10^7 points
+  const long maxReference = 10000000;
+  mt19937 rng(42);
+
+  cout << "Points;Distribution;Sommets;Temps (ms);Temps référence (ms);Identique;" << endl;
+  long n = 10;
+  for (int e = 1; e <= maxExponent; e++, n *= 10)
+  {
+    for (bool disk : {false, true})
+    {
+      vector<Z2i::Point> points = randomPoints(n, disk, rng);
+
+      auto start = chrono::steady_clock::now();
+      vector<Z2i::Point> hull = convexHull(points);
+      double time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+      cout << n << ';' << (disk ? "disque" : "carré") << ';' << hull.size() << ';' << time << ';';
+      if (n <= maxReference)
+      {
+        start = chrono::steady_clock::now();
+        vector<Z2i::Point> reference = referenceHull(points);
+        double referenceTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << referenceTime << ';' << (reference == hull ? "oui" : "non") << ';';
+      }
+      else
+        cout << "-;-;";
+      cout << endl;
+    }
+  }
+  return 0;
+}
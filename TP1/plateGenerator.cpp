@@ -0,0 +1,307 @@
+///////////////////////////////////////////////////////////////////////////////
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DGtal/base/Common.h"
+#include "DGtal/helpers/StdDefs.h"
+
+//shape and digitizer
+#include "DGtal/shapes/Shapes.h"
+#include "DGtal/shapes/ShapeFactory.h"
+#include "DGtal/shapes/GaussDigitizer.h"
+
+//tracking grid curve
+#include "DGtal/topology/helpers/Surfaces.h"
+///////////////////////////////////////////////////////////////////////////////
+
+using namespace DGtal;
+using namespace Z2i;
+using namespace std;
+
+typedef ImplicitBall<Z2i::Space> Disk;
+typedef AccFlower2D<Z2i::Space> Flower;
+typedef Ellipse2D<Z2i::Space> Ellipse;
+
+// number of rows rasterised at once, the plate is never held in memory
+const int BAND_HEIGHT = 256;
+
+enum GrainType
+{
+  ELLIPSE,
+  FLOWER,
+  DISK
+};
+const char *GRAIN_TYPE_NAMES[] = {"ellipse", "flower", "disk"};
+
+// description of one grain, the shape is rebuilt from it when needed
+struct Grain
+{
+  GrainType type;
+  double x, y;    // center
+  double a, b;    // radii (big and small radius for the flower)
+  double theta;   // rotation
+  double radius;  // bounding radius
+  int area;
+  int perimeter;
+};
+
+template <typename Shape>
+GaussDigitizer<Z2i::Space, Shape> makeDigitizer(const Shape &shape)
+{
+  double h = 1;
+  GaussDigitizer<Z2i::Space, Shape> dig;
+  dig.attach(shape);
+  dig.init(shape.getLowerBound() + Z2i::RealVector(-1, -1),
+           shape.getUpperBound() + Z2i::RealVector(1, 1), h);
+  return dig;
+}
+
+// area and perimeter of the digitized shape, as findValues() in main.cpp
+template <typename Shape>
+void measure(const Shape &shape, Grain &grain)
+{
+  auto dig = makeDigitizer(shape);
+
+  // make a Kovalevsky-Khalimsky space
+  Z2i::KSpace ks;
+  ks.init(dig.getLowerBound(), dig.getUpperBound(), true);
+  // set an adjacency (4-connectivity)
+  SurfelAdjacency<2> sAdj(true);
+
+  // search for one boundary element
+  Z2i::SCell bel = Surfaces<Z2i::KSpace>::findABel(ks, dig, 100000);
+  // boundary tracking
+  std::vector<Z2i::Point> boundaryPoints;
+  Surfaces<Z2i::KSpace>::track2DBoundaryPoints(boundaryPoints, ks, sAdj, dig, bel);
+
+  Domain domain(dig.getLowerBound(), dig.getUpperBound());
+  Z2i::DigitalSet aSet(domain);
+  Shapes<Z2i::Domain>::digitalShaper(aSet, dig);
+
+  grain.perimeter = boundaryPoints.size();
+  grain.area = aSet.size();
+}
+
+// set the pixels of the shape lying in the rows [y0, y1) of the band
+template <typename Shape>
+void rasterize(const Shape &shape, vector<unsigned char> &band, int width, int y0, int y1)
+{
+  auto dig = makeDigitizer(shape);
+  Z2i::Point lower = dig.getLowerBound();
+  Z2i::Point upper = dig.getUpperBound();
+  for (int y = max(y0, (int)lower[1]); y <= min(y1 - 1, (int)upper[1]); y++)
+    for (int x = max(0, (int)lower[0]); x <= min(width - 1, (int)upper[0]); x++)
+      if (dig(Z2i::Point(x, y)))
+        band[(y - y0) * width + x] = 255;
+}
+
+// true when the two digitized shapes share a pixel, a side or a corner
+template <typename Shape1, typename Shape2>
+bool touch(const Shape1 &shape1, const Shape2 &shape2)
+{
+  auto dig1 = makeDigitizer(shape1);
+  auto dig2 = makeDigitizer(shape2);
+  Z2i::Point lower = dig1.getLowerBound().sup(dig2.getLowerBound() - Z2i::Point(1, 1));
+  Z2i::Point upper = dig1.getUpperBound().inf(dig2.getUpperBound() + Z2i::Point(1, 1));
+  for (int y = lower[1]; y <= upper[1]; y++)
+    for (int x = lower[0]; x <= upper[0]; x++)
+    {
+      if (!dig1(Z2i::Point(x, y)))
+        continue;
+      for (int dy = -1; dy <= 1; dy++)
+        for (int dx = -1; dx <= 1; dx++)
+          if (dig2(Z2i::Point(x + dx, y + dy)))
+            return true;
+    }
+  return false;
+}
+
+// call f with the Euclidean shape of the grain
+template <typename F>
+void withShape(const Grain &grain, F f)
+{
+  const Z2i::RealPoint center(grain.x, grain.y);
+  switch (grain.type)
+  {
+  case ELLIPSE:
+    f(Ellipse(center, grain.a, grain.b, grain.theta));
+    break;
+  case FLOWER:
+    f(Flower(center, grain.a, grain.b, 5, grain.theta));
+    break;
+  case DISK:
+    f(Disk(center, grain.a));
+    break;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  if (argc < 6)
+  {
+    cout << "Usage: plateGenerator width height count seed output [touching]" << endl;
+    return 0;
+  }
+  const int width = atoi(argv[1]);
+  const int height = atoi(argv[2]);
+  const long count = atol(argv[3]);
+  const unsigned int seed = atoi(argv[4]);
+  const string output(argv[5]);
+  const bool touching = argc > 6 && string(argv[6]) == "touching";
+
+  mt19937 rng(seed);
+  uniform_real_distribution<double> uniform(0., 1.);
+
+  // random grains, mostly rice-like ellipses, the neighbours are found using a grid of cells
+  // without touching, bounding circles are kept two pixels apart,
+  // with touching, no center lies inside the bounding circle of another grain,
+  // so that grains touch or overlap a little but one never covers the other
+  const double maxRadius = 22;
+  const int cellSize = 2 * maxRadius + 2;
+  const int cellsX = width / cellSize + 1;
+  const int cellsY = height / cellSize + 1;
+  vector<vector<int>> cells((size_t)cellsX * cellsY);
+  vector<Grain> grains;
+  long attempts = 0;
+  while ((long)grains.size() < count && attempts < 20 * count)
+  {
+    attempts++;
+    Grain g;
+    double kind = uniform(rng);
+    g.theta = uniform(rng) * M_PI;
+    if (kind < 0.8)
+    {
+      g.type = ELLIPSE;
+      g.a = 12 + 8 * uniform(rng);
+      g.b = 4 + 3 * uniform(rng);
+      g.radius = g.a;
+    }
+    else if (kind < 0.9)
+    {
+      g.type = FLOWER;
+      g.a = 10 + 4 * uniform(rng);
+      g.b = 3 + 2 * uniform(rng);
+      g.radius = g.a + g.b;
+    }
+    else
+    {
+      g.type = DISK;
+      g.a = 6 + 4 * uniform(rng);
+      g.b = g.a;
+      g.radius = g.a;
+    }
+    // keep the grain inside the plate
+    g.x = g.radius + 2 + uniform(rng) * (width - 2 * g.radius - 4);
+    g.y = g.radius + 2 + uniform(rng) * (height - 2 * g.radius - 4);
+    if (g.x < g.radius + 2 || g.y < g.radius + 2)
+      continue;
+
+    int cx = g.x / cellSize;
+    int cy = g.y / cellSize;
+    bool isFree = true;
+    for (int ny = max(0, cy - 1); ny <= min(cellsY - 1, cy + 1) && isFree; ny++)
+      for (int nx = max(0, cx - 1); nx <= min(cellsX - 1, cx + 1) && isFree; nx++)
+        for (int other : cells[ny * cellsX + nx])
+        {
+          const Grain &o = grains[other];
+          double d = touching ? max(g.radius, o.radius) : g.radius + o.radius + 2;
+          if ((g.x - o.x) * (g.x - o.x) + (g.y - o.y) * (g.y - o.y) < d * d)
+          {
+            isFree = false;
+            break;
+          }
+        }
+    if (!isFree)
+      continue;
+    cells[cy * cellsX + cx].push_back(grains.size());
+
+    withShape(g, [&](const auto &shape) { measure(shape, g); });
+    grains.push_back(g);
+  }
+  if ((long)grains.size() < count)
+    cout << "Only " << grains.size() << " grains fit on the plate" << endl;
+
+  // touching grains, only bounding circles less than two pixels apart are compared
+  vector<vector<int>> neighbours(grains.size());
+  for (size_t i = 0; i < grains.size(); i++)
+  {
+    const Grain &g = grains[i];
+    int cx = g.x / cellSize;
+    int cy = g.y / cellSize;
+    for (int ny = max(0, cy - 1); ny <= min(cellsY - 1, cy + 1); ny++)
+      for (int nx = max(0, cx - 1); nx <= min(cellsX - 1, cx + 1); nx++)
+        for (int other : cells[ny * cellsX + nx])
+        {
+          const Grain &o = grains[other];
+          double d = g.radius + o.radius + 2;
+          if (other <= (int)i || (g.x - o.x) * (g.x - o.x) + (g.y - o.y) * (g.y - o.y) >= d * d)
+            continue;
+          bool isTouching = false;
+          withShape(g, [&](const auto &shape) {
+            withShape(o, [&](const auto &otherShape) { isTouching = touch(shape, otherShape); });
+          });
+          if (isTouching)
+          {
+            neighbours[i].push_back(other);
+            neighbours[other].push_back(i);
+          }
+        }
+  }
+
+  // ground truth, the touching grains are listed as comma separated ids
+  ofstream truth(output + "_truth.csv");
+  truth << "count;" << grains.size() << endl;
+  truth << "id;type;x;y;area;perimeter;touching" << endl;
+  for (size_t i = 0; i < grains.size(); i++)
+  {
+    const Grain &g = grains[i];
+    truth << i << ';' << GRAIN_TYPE_NAMES[g.type] << ';' << g.x << ';' << g.y << ';' << g.area << ';' << g.perimeter << ';';
+    sort(neighbours[i].begin(), neighbours[i].end());
+    for (size_t k = 0; k < neighbours[i].size(); k++)
+      truth << (k == 0 ? "" : ",") << neighbours[i][k];
+    truth << endl;
+  }
+
+  // rasterise the plate band by band, from the top row written first in the PGM
+  // (the reader puts it at y = height - 1), grains sorted by their top row
+  vector<int> order(grains.size());
+  for (size_t i = 0; i < order.size(); i++)
+    order[i] = i;
+  sort(order.begin(), order.end(), [&](int i, int j) {
+    return grains[i].y + grains[i].radius > grains[j].y + grains[j].radius;
+  });
+
+  ofstream pgm(output + ".pgm", ios::binary);
+  pgm << "P5" << endl
+      << width << " " << height << endl
+      << 255 << endl;
+  vector<unsigned char> band((size_t)width * BAND_HEIGHT);
+  vector<int> active;
+  size_t next = 0;
+  for (int y1 = height; y1 > 0; y1 -= BAND_HEIGHT)
+  {
+    int y0 = max(0, y1 - BAND_HEIGHT);
+    fill(band.begin(), band.end(), 0);
+
+    // grains reaching the band become active
+    while (next < order.size() && grains[order[next]].y + grains[order[next]].radius + 2 >= y0)
+      active.push_back(order[next++]);
+    // grains above the band are done
+    active.erase(remove_if(active.begin(), active.end(), [&](int i) {
+                   return grains[i].y - grains[i].radius - 2 >= y1;
+                 }),
+                 active.end());
+
+    for (int i : active)
+      withShape(grains[i], [&](const auto &shape) { rasterize(shape, band, width, y0, y1); });
+
+    for (int y = y1 - 1; y >= y0; y--)
+      pgm.write((const char *)&band[(size_t)(y - y0) * width], width);
+  }
+  return 0;
+}
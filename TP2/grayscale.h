@@ -0,0 +1,186 @@
+#ifndef GRAYSCALE_H
+#define GRAYSCALE_H
+
+#include <DGtal/base/Common.h>
+#include <DGtal/helpers/StdDefs.h>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Binarisation of 8-bit grayscale images, straight into a digital set.
+// The image is expected to be an ImageContainerBySTLVector (a std::vector of the pixels, x first).
+
+template <class Image>
+const unsigned char *pixels(const Image &image)
+{
+    return static_cast<const std::vector<unsigned char> &>(image).data();
+}
+
+// Run f(begin, end, threadIndex) on the [0, size) range cut in one slice per thread.
+template <class F>
+void parallelSlices(size_t size, F f)
+{
+    unsigned int nbThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t slice = (size + nbThreads - 1) / nbThreads;
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < nbThreads; t++)
+    {
+        size_t begin = std::min(size, t * slice);
+        size_t end = std::min(size, begin + slice);
+        threads.push_back(std::thread(f, begin, end, t));
+    }
+    for (auto &t : threads)
+        t.join();
+}
+
+// Histogram of the gray levels.
+// Each thread fills four partial histograms, one per pixel of a group of four,
+// so that consecutive equal pixels do not wait on the same counter.
+template <class Image>
+std::vector<unsigned int> histogram(const Image &image)
+{
+    const unsigned char *data = pixels(image);
+    const size_t size = image.domain().size();
+    unsigned int nbThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned int> partial(nbThreads * 4 * 256, 0);
+
+    parallelSlices(size, [&](size_t begin, size_t end, unsigned int t) {
+        unsigned int *h = &partial[t * 4 * 256];
+        size_t i = begin;
+        for (; i + 4 <= end; i += 4)
+        {
+            h[data[i]]++;
+            h[256 + data[i + 1]]++;
+            h[512 + data[i + 2]]++;
+            h[768 + data[i + 3]]++;
+        }
+        for (; i < end; i++)
+            h[data[i]]++;
+    });
+
+    std::vector<unsigned int> hist(256, 0);
+    for (unsigned int k = 0; k < nbThreads * 4; k++)
+        for (int v = 0; v < 256; v++)
+            hist[v] += partial[k * 256 + v];
+    return hist;
+}
+
+// Otsu threshold: the level maximising the between-class variance.
+// Pixels strictly above the returned level are foreground.
+inline int otsuThreshold(const std::vector<unsigned int> &hist)
+{
+    double total = 0;
+    double sum = 0;
+    for (int v = 0; v < 256; v++)
+    {
+        total += hist[v];
+        sum += (double)v * hist[v];
+    }
+
+    double weightBackground = 0;
+    double sumBackground = 0;
+    double bestVariance = -1;
+    int threshold = 0;
+    for (int v = 0; v < 256; v++)
+    {
+        weightBackground += hist[v];
+        if (weightBackground == 0)
+            continue;
+        double weightForeground = total - weightBackground;
+        if (weightForeground == 0)
+            break;
+        sumBackground += (double)v * hist[v];
+        double meanBackground = sumBackground / weightBackground;
+        double meanForeground = (sum - sumBackground) / weightForeground;
+        double variance = weightBackground * weightForeground * (meanBackground - meanForeground) * (meanBackground - meanForeground);
+        if (variance > bestVariance)
+        {
+            bestVariance = variance;
+            threshold = v;
+        }
+    }
+    return threshold;
+}
+
+// Insert every pixel strictly above threshold in the set.
+// With SSE2, sixteen pixels are compared at once and empty blocks are skipped.
+template <class Set, class Image>
+void appendThreshold(Set &set, const Image &image, int threshold)
+{
+    const unsigned char *data = pixels(image);
+    const DGtal::Z2i::Point lower = image.domain().lowerBound();
+    const int width = image.domain().upperBound()[0] - lower[0] + 1;
+    const size_t size = image.domain().size();
+
+    size_t i = 0;
+#ifdef __SSE2__
+    // unsigned comparison through the signed one, by flipping the sign bit
+    const __m128i flip = _mm_set1_epi8((char)0x80);
+    const __m128i level = _mm_set1_epi8((char)(threshold ^ 0x80));
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(data + i)), flip);
+        int mask = _mm_movemask_epi8(_mm_cmpgt_epi8(block, level));
+        while (mask != 0)
+        {
+            int bit = __builtin_ctz(mask);
+            mask &= mask - 1;
+            size_t j = i + bit;
+            set.insertNew(DGtal::Z2i::Point(lower[0] + j % width, lower[1] + j / width));
+        }
+    }
+#endif
+    for (; i < size; i++)
+        if (data[i] > threshold)
+            set.insertNew(DGtal::Z2i::Point(lower[0] + i % width, lower[1] + i / width));
+}
+
+// Adaptive threshold: a pixel is foreground when it is brighter than the mean
+// of the window x window square around it plus offset.
+// The local means come from an integral image computed one row per thread.
+template <class Set, class Image>
+void appendAdaptiveThreshold(Set &set, const Image &image, int window, int offset)
+{
+    const unsigned char *data = pixels(image);
+    const DGtal::Z2i::Point lower = image.domain().lowerBound();
+    const int width = image.domain().upperBound()[0] - lower[0] + 1;
+    const int height = image.domain().upperBound()[1] - lower[1] + 1;
+
+    // integral image with a zero first row and column
+    std::vector<unsigned int> integral((width + 1) * (height + 1), 0);
+    parallelSlices(height, [&](size_t begin, size_t end, unsigned int) {
+        for (size_t y = begin; y < end; y++)
+        {
+            unsigned int rowSum = 0;
+            for (int x = 0; x < width; x++)
+            {
+                rowSum += data[y * width + x];
+                integral[(y + 1) * (width + 1) + x + 1] = rowSum;
+            }
+        }
+    });
+    for (int y = 1; y <= height; y++)
+        for (int x = 1; x <= width; x++)
+            integral[y * (width + 1) + x] += integral[(y - 1) * (width + 1) + x];
+
+    const int radius = window / 2;
+    for (int y = 0; y < height; y++)
+    {
+        int y0 = std::max(0, y - radius);
+        int y1 = std::min(height, y + radius + 1);
+        for (int x = 0; x < width; x++)
+        {
+            int x0 = std::max(0, x - radius);
+            int x1 = std::min(width, x + radius + 1);
+            unsigned int sum = integral[y1 * (width + 1) + x1] - integral[y0 * (width + 1) + x1] - integral[y1 * (width + 1) + x0] + integral[y0 * (width + 1) + x0];
+            int count = (x1 - x0) * (y1 - y0);
+            if ((int)data[y * width + x] * count > (int)sum + offset * count)
+                set.insertNew(DGtal::Z2i::Point(lower[0] + x, lower[1] + y));
+        }
+    }
+}
+
+#endif
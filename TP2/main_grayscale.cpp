@@ -0,0 +1,119 @@
+#include <DGtal/base/Common.h>
+#include <DGtal/helpers/StdDefs.h>
+#include <DGtal/images/ImageSelector.h>
+#include <DGtal/io/readers/PGMReader.h>
+#include <DGtal/topology/SurfelAdjacency.h>
+#include <DGtal/topology/helpers/Surfaces.h>
+#include "grayscale.h"
+#define MAXIMUM_SEARCH 100000
+#define ADAPTIVE_WINDOW 51
+#define ADAPTIVE_OFFSET 10
+
+using namespace std;
+using namespace DGtal;
+using namespace Z2i;
+
+typedef ImageSelector<Domain, unsigned char>::Type ImageType;
+typedef Object<DT4_8, DigitalSet> ObjectType48;
+typedef Object<DT8_4, DigitalSet> ObjectType84;
+
+template <class T>
+Curve boundary(T &object, bool is4_8)
+{
+    // make a Kovalevsky-Khalimsky space
+    KSpace t_KSpace;
+    t_KSpace.init(object.domain().lowerBound() - Point(2, 2), object.domain().upperBound() + Point(2, 2), true);
+
+    // set an adjacency (4-connectivity)
+    SurfelAdjacency<2> sAdj(is4_8);
+
+    // search for one boundary element
+    SCell bel = Surfaces<KSpace>::findABel(t_KSpace, object.pointSet(), MAXIMUM_SEARCH);
+
+    // boundary points
+    vector<Point> t_BoundaryPoints;
+    Surfaces<KSpace>::track2DBoundaryPoints(t_BoundaryPoints, t_KSpace, sAdj, object.pointSet(), bel);
+
+    // obtain a curve
+    Curve boundaryCurve;
+    boundaryCurve.initFromVector(t_BoundaryPoints);
+
+    return boundaryCurve;
+}
+
+template <class T>
+int countInside(vector<T> &objects, bool is4_8, int xLimit, int yLimit)
+{
+    int count = 0;
+    for (auto &o : objects)
+    {
+        Curve c = boundary(o, is4_8);
+        bool isIn = true;
+        for (auto &p : c)
+        {
+            PointVector<2, Integer> point = p.preCell().coordinates;
+            if (point[0] <= 0 || point[0] >= xLimit || point[1] <= 0 || point[1] >= yLimit)
+            {
+                isIn = false;
+                break;
+            }
+        }
+        if (isIn)
+            count++;
+    }
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+
+    if (argc < 2)
+    {
+        cout << "Please give me a grayscale picture as argument, then otsu (default) or adaptive" << endl;
+        return 0;
+    }
+    const string mode = argc > 2 ? argv[2] : "otsu";
+
+    // read a grayscale image
+    ImageType image = PGMReader<ImageType>::importPGM(argv[1]);
+
+    // digital set, filled directly by the thresholding
+    DigitalSet set2d(image.domain());
+    if (mode == "adaptive")
+    {
+        appendAdaptiveThreshold(set2d, image, ADAPTIVE_WINDOW, ADAPTIVE_OFFSET);
+        cout << "Seuil adaptatif: fenêtre " << ADAPTIVE_WINDOW << ", décalage " << ADAPTIVE_OFFSET << endl;
+    }
+    else
+    {
+        int threshold = otsuThreshold(histogram(image));
+        appendThreshold(set2d, image, threshold);
+        cout << "Seuil d'Otsu: " << threshold << endl;
+    }
+
+    // vector of digital object
+    // (4,8) adjacency
+    vector<ObjectType48> objects48;
+    back_insert_iterator<vector<ObjectType48>> inserter48(objects48);
+    // (8,4) adjacency
+    vector<ObjectType84> objects84;
+    back_insert_iterator<vector<ObjectType84>> inserter84(objects84);
+
+    // connected components
+    // (4,8) adjacency
+    ObjectType48 bdiamond48(dt4_8, set2d);
+    bdiamond48.writeComponents(inserter48);
+    // (8,4) adjacency
+    ObjectType84 bdiamond84(dt8_4, set2d);
+    bdiamond84.writeComponents(inserter84);
+
+    // Find limits
+    int xLimit = image.domain().upperBound()[0] * 2;
+    int yLimit = image.domain().upperBound()[1] * 2;
+
+    cout << "Nombre de grains de riz 4_8: " << endl;
+    cout << countInside(objects48, true, xLimit, yLimit) << endl;
+    cout << "Nombre de grains de riz 8_4: " << endl;
+    cout << countInside(objects84, false, xLimit, yLimit) << endl;
+    return 0;
+}
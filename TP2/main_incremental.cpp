@@ -0,0 +1,274 @@
+#include <DGtal/base/Common.h>
+#include <DGtal/helpers/StdDefs.h>
+#include <DGtal/images/ImageSelector.h>
+#include <DGtal/io/readers/PGMReader.h>
+#include <DGtal/topology/SurfelAdjacency.h>
+#include <DGtal/topology/helpers/Surfaces.h>
+#include <DGtal/geometry/curves/GreedySegmentation.h>
+#include <math.h>
+#include <map>
+#include <string.h>
+#include "grayscale.h"
+#define MAXIMUM_SEARCH 100000
+// side of the blocks compared between two frames
+#define BLOCK_SIZE 32
+
+using namespace std;
+using namespace DGtal;
+using namespace Z2i;
+
+typedef ImageSelector<Domain, unsigned char>::Type ImageType;
+typedef Object<DT4_8, DigitalSet> ObjectType48;
+
+typedef FreemanChain<int> Border4;
+typedef ArithmeticalDSSComputer<Border4::ConstIterator, int, 4> DSS4;
+typedef GreedySegmentation<DSS4> Decomposition4;
+
+// cached measurements of one grain
+struct Grain
+{
+    vector<int> pixels; // indices in the frame
+    bool isIn;
+    int boundarySize;
+    double circularity;
+    double dssPerimeter;
+    double dssCircularity;
+};
+
+template <class T>
+Curve boundary(T &o, bool is4_8)
+{
+    // make a Kovalevsky-Khalimsky space
+    KSpace t_KSpace;
+    t_KSpace.init(o.domain().lowerBound() - Point(2, 2), o.domain().upperBound() + Point(2, 2), true);
+
+    // set an adjacency (4-connectivity)
+    SurfelAdjacency<2> sAdj(is4_8);
+
+    // search for one boundary element
+    SCell bel = Surfaces<KSpace>::findABel(t_KSpace, o.pointSet(), MAXIMUM_SEARCH);
+
+    // boundary points
+    vector<Point> t_BoundaryPoints;
+    Surfaces<KSpace>::track2DBoundaryPoints(t_BoundaryPoints, t_KSpace, sAdj, o.pointSet(), bel);
+
+    // obtain a curve
+    Curve boundaryCurve;
+    boundaryCurve.initFromVector(t_BoundaryPoints);
+
+    return boundaryCurve;
+}
+
+// Same measurements as segmentation() in main_step4_step5_step6.cpp, stored in the grain
+template <class T>
+void segmentation(T &o, Grain &grain)
+{
+    // make a Kovalevsky-Khalimsky space
+    KSpace t_KSpace;
+    t_KSpace.init(o.domain().lowerBound() - Point(2, 2), o.domain().upperBound() + Point(2, 2), true);
+
+    // set an adjacency (4-connectivity)
+    SurfelAdjacency<2> sAdj(true);
+
+    // search for one boundary element
+    SCell bel = Surfaces<KSpace>::findABel(t_KSpace, o.pointSet(), MAXIMUM_SEARCH);
+
+    // boundary tracking
+    std::vector<Z2i::Point> t_BoundaryPoints;
+    Surfaces<Z2i::KSpace>::track2DBoundaryPoints(t_BoundaryPoints, t_KSpace, sAdj, o.pointSet(), bel);
+
+    // Construct the Freeman chain
+    Border4 t_Contour(t_BoundaryPoints);
+    // Segmentation
+    Decomposition4 t_Decomposition(t_Contour.begin(), t_Contour.end(), DSS4());
+
+    double perimeter = 0;
+    double partialArea = 0;
+
+    auto itEnd = t_Decomposition.end();
+    auto firstPoint = t_Decomposition.begin().begin().get();
+    Point lastPoint;
+    for (Decomposition4::SegmentComputerIterator it = t_Decomposition.begin(); it != itEnd; ++it)
+    {
+        auto p = it.get().begin().get();
+        auto q = it.get().end().get();
+        perimeter += sqrt(pow(q[0] - p[0], 2) + pow(q[1] - p[1], 2));
+        partialArea += p[0] * q[1] - p[1] * q[0];
+        lastPoint = q;
+    }
+
+    perimeter += sqrt(pow(firstPoint[0] - lastPoint[0], 2) + pow(firstPoint[1] - lastPoint[1], 2));
+    partialArea += lastPoint[0] * firstPoint[1] - lastPoint[1] * firstPoint[0];
+    double area = abs(partialArea) * 0.5;
+
+    grain.dssPerimeter = perimeter;
+    grain.dssCircularity = (4 * M_PI * area) / (perimeter * perimeter);
+}
+
+int main(int argc, char **argv)
+{
+
+    if (argc < 2)
+    {
+        cout << "Please give me the picture names of the consecutive frames as arguments" << endl;
+        return 0;
+    }
+    const string filestart = "../RiceGrains/Rice_";
+    const string fileend = "_seg_bin.pgm";
+
+    Domain domain;
+    int width = 0;
+    int height = 0;
+    int blocksX = 0;
+    int blocksY = 0;
+    vector<unsigned char> previous; // previous frame, empty before the first one
+    vector<int> labels;             // grain id of each pixel, 0 for the background
+    map<int, Grain> grains;
+    int nextId = 1;
+
+    for (int f = 1; f < argc; f++)
+    {
+        ImageType image = PGMReader<ImageType>::importPGM(filestart + argv[f] + fileend);
+        const unsigned char *data = pixels(image);
+
+        // a frame of another size starts the tracking over
+        if (f == 1 || !(image.domain().lowerBound() == domain.lowerBound() && image.domain().upperBound() == domain.upperBound()))
+        {
+            domain = image.domain();
+            width = domain.upperBound()[0] - domain.lowerBound()[0] + 1;
+            height = domain.upperBound()[1] - domain.lowerBound()[1] + 1;
+            blocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            blocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            previous.assign(width * height, 0);
+            labels.assign(width * height, 0);
+            grains.clear();
+        }
+
+        // dirty blocks, grown by one block so that the neighbouring grains are revisited
+        vector<bool> dirty(blocksX * blocksY, false);
+        int nbDirty = 0;
+        for (int by = 0; by < blocksY; by++)
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                int x0 = bx * BLOCK_SIZE;
+                int x1 = min(width, x0 + BLOCK_SIZE);
+                bool changed = false;
+                for (int y = by * BLOCK_SIZE; y < min(height, (by + 1) * BLOCK_SIZE) && !changed; y++)
+                    changed = memcmp(data + y * width + x0, &previous[y * width + x0], x1 - x0) != 0;
+                if (!changed)
+                    continue;
+                nbDirty++;
+                for (int ny = max(0, by - 1); ny <= min(blocksY - 1, by + 1); ny++)
+                    for (int nx = max(0, bx - 1); nx <= min(blocksX - 1, bx + 1); nx++)
+                        dirty[ny * blocksX + nx] = true;
+            }
+
+        // invalidate the grains reaching the dirty area, and collect the seeds to relabel
+        vector<int> seeds;
+        for (int by = 0; by < blocksY; by++)
+            for (int bx = 0; bx < blocksX; bx++)
+            {
+                if (!dirty[by * blocksX + bx])
+                    continue;
+                for (int y = by * BLOCK_SIZE; y < min(height, (by + 1) * BLOCK_SIZE); y++)
+                    for (int x = bx * BLOCK_SIZE; x < min(width, (bx + 1) * BLOCK_SIZE); x++)
+                    {
+                        int i = y * width + x;
+                        int id = labels[i];
+                        if (id != 0)
+                        {
+                            for (int j : grains[id].pixels)
+                            {
+                                labels[j] = 0;
+                                seeds.push_back(j);
+                            }
+                            grains.erase(id);
+                        }
+                        seeds.push_back(i);
+                    }
+            }
+        int nbKept = grains.size();
+
+        // (4,8) connected components of the unlabeled foreground, from the seeds only
+        vector<int> newIds;
+        vector<int> stack;
+        for (int s : seeds)
+        {
+            if (data[s] == 0 || labels[s] != 0)
+                continue;
+            int id = nextId++;
+            Grain &grain = grains[id];
+            labels[s] = id;
+            stack.push_back(s);
+            while (!stack.empty())
+            {
+                int i = stack.back();
+                stack.pop_back();
+                grain.pixels.push_back(i);
+                int x = i % width;
+                int y = i / width;
+                int neighbours[4] = {x > 0 ? i - 1 : -1, x < width - 1 ? i + 1 : -1,
+                                     y > 0 ? i - width : -1, y < height - 1 ? i + width : -1};
+                for (int k : neighbours)
+                {
+                    if (k >= 0 && data[k] != 0 && labels[k] == 0)
+                    {
+                        labels[k] = id;
+                        stack.push_back(k);
+                    }
+                }
+            }
+            newIds.push_back(id);
+        }
+
+        // measure the new grains only
+        int xLimit = domain.upperBound()[0] * 2;
+        int yLimit = domain.upperBound()[1] * 2;
+        for (int id : newIds)
+        {
+            Grain &grain = grains[id];
+            DigitalSet grainSet(domain);
+            for (int i : grain.pixels)
+                grainSet.insertNew(domain.lowerBound() + Point(i % width, i / width));
+            ObjectType48 o(dt4_8, grainSet);
+
+            Curve c = boundary(o, true);
+            grain.isIn = true;
+            for (auto &p : c)
+            {
+                PointVector<2, Integer> point = p.preCell().coordinates;
+                if (point[0] <= 0 || point[0] >= xLimit || point[1] <= 0 || point[1] >= yLimit)
+                {
+                    grain.isIn = false;
+                    break;
+                }
+            }
+            grain.boundarySize = c.size();
+            grain.circularity = (4 * M_PI * o.size()) / (c.size() * c.size());
+            if (grain.isIn)
+                segmentation(o, grain);
+        }
+
+        int count = 0;
+        for (auto &g : grains)
+            if (g.second.isIn)
+                count++;
+        cout << argv[f] << ": blocs modifiés " << nbDirty << "/" << blocksX * blocksY
+             << ", grains conservés " << nbKept << ", grains recalculés " << newIds.size()
+             << ", nombre de grains de riz " << count << endl;
+
+        previous.assign(data, data + width * height);
+    }
+
+    // measurements of the last frame, in the format of main_step4_step5_step6.cpp
+    cout << "Perimètre 1;Circularité 1;Perimètre 2;Circularité 2;" << endl;
+    for (auto &g : grains)
+    {
+        const Grain &grain = g.second;
+        if (!grain.isIn)
+            continue;
+        cout << grain.boundarySize << ';' << grain.circularity << ';';
+        cout << grain.dssPerimeter << ';' << grain.dssCircularity << ';' << endl;
+    }
+    return 0;
+}
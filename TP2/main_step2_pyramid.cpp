@@ -0,0 +1,305 @@
+#include <DGtal/base/Common.h>
+#include <DGtal/helpers/StdDefs.h>
+#include <DGtal/images/ImageSelector.h>
+#include <DGtal/io/readers/PGMReader.h>
+#include <DGtal/images/imagesSetsUtils/SetFromImage.h>
+#include <DGtal/topology/SurfelAdjacency.h>
+#include <DGtal/topology/helpers/Surfaces.h>
+#include <algorithm>
+#include <chrono>
+#include "grayscale.h"
+#define MAXIMUM_SEARCH 100000
+// number of reductions by 2 of the pyramid
+#define PYRAMID_LEVELS 2
+// a coarse grain outside [1 / AMBIGUOUS_FACTOR, AMBIGUOUS_FACTOR] times the median area is ambiguous
+#define AMBIGUOUS_FACTOR 1.5
+
+using namespace std;
+using namespace DGtal;
+using namespace Z2i;
+
+typedef ImageSelector<Domain, unsigned char>::Type ImageType;
+typedef Object<DT4_8, DigitalSet> ObjectType48;
+
+// binary image of one level of the pyramid
+struct Level
+{
+    int width;
+    int height;
+    vector<unsigned char> mask;
+};
+
+template <class T>
+Curve boundary(T &object, bool is4_8)
+{
+    // make a Kovalevsky-Khalimsky space
+    KSpace t_KSpace;
+    t_KSpace.init(object.domain().lowerBound() - Point(2, 2), object.domain().upperBound() + Point(2, 2), true);
+
+    // set an adjacency (4-connectivity)
+    SurfelAdjacency<2> sAdj(is4_8);
+
+    // search for one boundary element
+    SCell bel = Surfaces<KSpace>::findABel(t_KSpace, object.pointSet(), MAXIMUM_SEARCH);
+
+    // boundary points
+    vector<Point> t_BoundaryPoints;
+    Surfaces<KSpace>::track2DBoundaryPoints(t_BoundaryPoints, t_KSpace, sAdj, object.pointSet(), bel);
+
+    // obtain a curve
+    Curve boundaryCurve;
+    boundaryCurve.initFromVector(t_BoundaryPoints);
+
+    return boundaryCurve;
+}
+
+// Count the (4,8) components of set2d that do not touch the border, as main_step2_elimination.cpp does
+int countInside(DigitalSet &set2d, int xLimit, int yLimit)
+{
+    vector<ObjectType48> objects48;
+    back_insert_iterator<vector<ObjectType48>> inserter48(objects48);
+    ObjectType48 bdiamond48(dt4_8, set2d);
+    bdiamond48.writeComponents(inserter48);
+
+    int count = 0;
+    for (auto &o : objects48)
+    {
+        Curve c = boundary(o, true);
+        bool isIn = true;
+        for (auto &p : c)
+        {
+            PointVector<2, Integer> point = p.preCell().coordinates;
+            if (point[0] <= 0 || point[0] >= xLimit || point[1] <= 0 || point[1] >= yLimit)
+            {
+                isIn = false;
+                break;
+            }
+        }
+        if (isIn)
+            count++;
+    }
+    return count;
+}
+
+// Reduction by 2: with isStrict false (OR), a coarse pixel is set when one of its four
+// fine pixels is, with isStrict true (AND) when all of them are.
+// A 4-connected fine grain stays inside one 4-connected OR coarse grain, so refining
+// a coarse grain only needs the fine pixels under it. The OR reduction also merges
+// the grains closer than 2^levels pixels, the AND reduction keeps them apart (or
+// erases the thin ones) and tells which coarse grains may hold several grains.
+Level reduce(const Level &fine, bool isStrict)
+{
+    Level coarse;
+    coarse.width = (fine.width + 1) / 2;
+    coarse.height = (fine.height + 1) / 2;
+    coarse.mask.assign(coarse.width * coarse.height, isStrict ? 1 : 0);
+    for (int y = 0; y < fine.height; y++)
+        for (int x = 0; x < fine.width; x++)
+        {
+            if (isStrict)
+                coarse.mask[(y / 2) * coarse.width + x / 2] &= fine.mask[y * fine.width + x];
+            else
+                coarse.mask[(y / 2) * coarse.width + x / 2] |= fine.mask[y * fine.width + x];
+        }
+    // a block cut by the right or top side is incomplete, it is not set by AND
+    if (isStrict)
+    {
+        if (fine.width % 2 != 0)
+            for (int y = 0; y < coarse.height; y++)
+                coarse.mask[y * coarse.width + coarse.width - 1] = 0;
+        if (fine.height % 2 != 0)
+            for (int x = 0; x < coarse.width; x++)
+                coarse.mask[(coarse.height - 1) * coarse.width + x] = 0;
+    }
+    return coarse;
+}
+
+// 4-connected components of a level, labels[i] is 1 + the index of the component of pixel i
+vector<vector<int>> components4(const Level &level, vector<int> &labels)
+{
+    labels.assign(level.mask.size(), 0);
+    vector<vector<int>> components;
+    vector<int> stack;
+    for (int s = 0; s < (int)level.mask.size(); s++)
+    {
+        if (level.mask[s] == 0 || labels[s] != 0)
+            continue;
+        components.push_back(vector<int>());
+        labels[s] = components.size();
+        stack.push_back(s);
+        while (!stack.empty())
+        {
+            int i = stack.back();
+            stack.pop_back();
+            components.back().push_back(i);
+            int x = i % level.width;
+            int y = i / level.width;
+            int neighbours[4] = {x > 0 ? i - 1 : -1, x < level.width - 1 ? i + 1 : -1,
+                                 y > 0 ? i - level.width : -1, y < level.height - 1 ? i + level.width : -1};
+            for (int k : neighbours)
+            {
+                if (k >= 0 && level.mask[k] != 0 && labels[k] == 0)
+                {
+                    labels[k] = components.size();
+                    stack.push_back(k);
+                }
+            }
+        }
+    }
+    return components;
+}
+
+struct Result
+{
+    int count;
+    int sure;
+    int refined;
+};
+
+Result pyramidCount(const ImageType &image, int levels, bool verbose)
+{
+    const Domain domain = image.domain();
+    const unsigned char *data = pixels(image);
+
+    // OR and AND pyramids
+    vector<Level> pyramid(1);
+    pyramid[0].width = domain.upperBound()[0] - domain.lowerBound()[0] + 1;
+    pyramid[0].height = domain.upperBound()[1] - domain.lowerBound()[1] + 1;
+    pyramid[0].mask.resize(pyramid[0].width * pyramid[0].height);
+    for (size_t i = 0; i < pyramid[0].mask.size(); i++)
+        pyramid[0].mask[i] = data[i] != 0;
+    Level strict = pyramid[0];
+    for (int l = 0; l < levels; l++)
+    {
+        pyramid.push_back(reduce(pyramid.back(), false));
+        strict = reduce(strict, true);
+    }
+    const Level &coarse = pyramid.back();
+
+    // 4-connected components at the coarse level
+    vector<int> labels;
+    vector<vector<int>> components = components4(coarse, labels);
+
+    // number of AND components under each OR component (AND is included in OR)
+    vector<int> strictLabels;
+    vector<int> cores(components.size(), 0);
+    for (auto &c : components4(strict, strictLabels))
+        cores[labels[c[0]] - 1]++;
+
+    vector<int> areas;
+    for (auto &c : components)
+        areas.push_back(c.size());
+    vector<int> sorted = areas;
+    sort(sorted.begin(), sorted.end());
+    double median = sorted.empty() ? 0 : sorted[sorted.size() / 2];
+
+    int xLimit = domain.upperBound()[0] * 2;
+    int yLimit = domain.upperBound()[1] * 2;
+    const int scale = 1 << levels;
+    const Level &fine = pyramid[0];
+
+    Result result = {0, 0, 0};
+    if (verbose)
+        cout << "Grain;Aire;Confiance;" << endl;
+    for (unsigned int g = 0; g < components.size(); g++)
+    {
+        bool onBorder = false;
+        for (int i : components[g])
+        {
+            int x = i % coarse.width;
+            int y = i / coarse.width;
+            if (x == 0 || y == 0 || x == coarse.width - 1 || y == coarse.height - 1)
+                onBorder = true;
+        }
+        // several AND components: grains merged by the OR reduction,
+        // none: a grain thinner than a block, which may be touching another one
+        bool ambiguous = onBorder || cores[g] != 1 ||
+                         areas[g] > AMBIGUOUS_FACTOR * median || areas[g] * AMBIGUOUS_FACTOR < median;
+
+        if (!ambiguous)
+        {
+            // a sure grain, counted at the coarse level
+            result.count++;
+            result.sure++;
+            if (verbose)
+                cout << g << ';' << areas[g] * scale * scale << ";sûr;" << endl;
+            continue;
+        }
+
+        // back to full resolution for the pixels under the coarse grain
+        DigitalSet set2d(domain);
+        for (int i : components[g])
+        {
+            int cx = i % coarse.width;
+            int cy = i / coarse.width;
+            for (int y = cy * scale; y < min(fine.height, (cy + 1) * scale); y++)
+                for (int x = cx * scale; x < min(fine.width, (cx + 1) * scale); x++)
+                    if (fine.mask[y * fine.width + x] != 0)
+                        set2d.insertNew(domain.lowerBound() + Point(x, y));
+        }
+        int count = countInside(set2d, xLimit, yLimit);
+        result.count += count;
+        result.refined++;
+        if (verbose)
+            cout << g << ';' << set2d.size() << ";affiné (" << count << " grains);" << endl;
+    }
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+
+    if (argc < 2)
+    {
+        cout << "Please give me the picture name as argument, or all for the benchmark on every picture" << endl;
+        return 0;
+    }
+    int levels = argc > 2 ? atoi(argv[2]) : PYRAMID_LEVELS;
+
+    const string filestart = "../RiceGrains/Rice_";
+    const string fileend = "_seg_bin.pgm";
+    vector<string> names;
+    if (string(argv[1]) == "all")
+        names = {"basmati", "camargue", "japonais", "mixed2", "mixed3"};
+    else
+        names.push_back(argv[1]);
+
+    vector<string> differing; // images where the pyramid count is not the full resolution one
+    for (auto &name : names)
+    {
+        ImageType image = PGMReader<ImageType>::importPGM(filestart + name + fileend);
+        int xLimit = image.domain().upperBound()[0] * 2;
+        int yLimit = image.domain().upperBound()[1] * 2;
+
+        // full resolution counting
+        auto start = chrono::steady_clock::now();
+        DigitalSet set2d(image.domain());
+        SetFromImage<DigitalSet>::append<ImageType>(set2d, image, 1, 255);
+        int fullCount = countInside(set2d, xLimit, yLimit);
+        double fullTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        // coarse to fine counting
+        start = chrono::steady_clock::now();
+        Result result = pyramidCount(image, levels, names.size() == 1);
+        double pyramidTime = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        if (&name == &names.front())
+            cout << "Image;Grains pleine résolution;Temps (ms);Grains pyramide;Sûrs;Affinés;Temps (ms);Écart;" << endl;
+        cout << name << ';' << fullCount << ';' << fullTime << ';'
+             << result.count << ';' << result.sure << ';' << result.refined << ';' << pyramidTime << ';'
+             << result.count - fullCount << ';' << endl;
+        if (result.count != fullCount)
+            differing.push_back(name);
+    }
+
+    if (differing.empty())
+        cout << "Comptes identiques à la pleine résolution" << endl;
+    else
+    {
+        cout << "Comptes différents de la pleine résolution :";
+        for (auto &name : differing)
+            cout << ' ' << name;
+        cout << endl;
+    }
+    return 0;
+}
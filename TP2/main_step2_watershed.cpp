@@ -0,0 +1,422 @@
+#include <DGtal/base/Common.h>
+#include <DGtal/helpers/StdDefs.h>
+#include <DGtal/images/ImageSelector.h>
+#include <DGtal/io/readers/PGMReader.h>
+#include <DGtal/images/imagesSetsUtils/SetFromImage.h>
+#include <DGtal/io/boards/Board2D.h>
+#include <DGtal/topology/SurfelAdjacency.h>
+#include <DGtal/topology/helpers/Surfaces.h>
+#include <DGtal/io/Color.h>
+#include <DGtal/geometry/curves/GreedySegmentation.h>
+#include <math.h>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#define MAXIMUM_SEARCH 100000
+// a component bigger than OVERSIZE_FACTOR times the median area is split
+#define OVERSIZE_FACTOR 1.6
+// a component less convex than this (area over convex hull area) is split
+#define MIN_SOLIDITY 0.85
+// a basin is kept as a grain when its dynamic reaches MIN_DYNAMIC (chamfer units, 3 per pixel)
+// and its area reaches MIN_AREA_RATIO times the median area
+#define MIN_DYNAMIC 6
+#define MIN_AREA_RATIO 0.2
+
+using namespace std;
+using namespace DGtal;
+using namespace Z2i;
+
+typedef ImageSelector<Domain, unsigned char>::Type ImageType;
+typedef Domain::ConstIterator DomainConstIterator;
+typedef DigitalSetSelector<Domain, BIG_DS + HIGH_BEL_DS>::Type DigitalSetType;
+typedef Object<DT4_8, DigitalSet> ObjectType48;
+typedef Object<DT8_4, DigitalSet> ObjectType84;
+
+typedef FreemanChain<int> Border4;
+typedef ArithmeticalDSSComputer<Border4::ConstIterator, int, 4> DSS4;
+typedef GreedySegmentation<DSS4> Decomposition4;
+
+template <class T>
+Curve boundary(T &o, bool is4_8)
+{
+    // make a Kovalevsky-Khalimsky space
+    KSpace t_KSpace;
+    t_KSpace.init(o.domain().lowerBound() - Point(2, 2), o.domain().upperBound() + Point(2, 2), true);
+
+    // set an adjacency (4-connectivity)
+    SurfelAdjacency<2> sAdj(is4_8);
+
+    // search for one boundary element
+    SCell bel = Surfaces<KSpace>::findABel(t_KSpace, o.pointSet(), MAXIMUM_SEARCH);
+
+    // boundary points
+    vector<Point> t_BoundaryPoints;
+    Surfaces<KSpace>::track2DBoundaryPoints(t_BoundaryPoints, t_KSpace, sAdj, o.pointSet(), bel);
+
+    // obtain a curve
+    Curve boundaryCurve;
+    boundaryCurve.initFromVector(t_BoundaryPoints);
+
+    return boundaryCurve;
+}
+
+template <class T>
+void segmentation(T &o, Domain domain)
+{
+    // make a Kovalevsky-Khalimsky space
+    KSpace t_KSpace;
+    t_KSpace.init(o.domain().lowerBound() - Point(2, 2), o.domain().upperBound() + Point(2, 2), true);
+
+    // set an adjacency (4-connectivity)
+    SurfelAdjacency<2> sAdj(true);
+
+    // search for one boundary element
+    SCell bel = Surfaces<KSpace>::findABel(t_KSpace, o.pointSet(), MAXIMUM_SEARCH);
+
+    // boundary tracking
+    std::vector<Z2i::Point> t_BoundaryPoints;
+    Surfaces<Z2i::KSpace>::track2DBoundaryPoints(t_BoundaryPoints, t_KSpace, sAdj, o.pointSet(), bel);
+
+    // Construct the Freeman chain
+    Border4 t_Contour(t_BoundaryPoints);
+    // Segmentation
+    Decomposition4 t_Decomposition(t_Contour.begin(), t_Contour.end(), DSS4());
+
+    double perimeter = 0;
+    double partialArea = 0;
+
+    auto itEnd = t_Decomposition.end();
+    auto firstPoint = t_Decomposition.begin().begin().get();
+    Point lastPoint;
+    for (Decomposition4::SegmentComputerIterator it = t_Decomposition.begin(); it != itEnd; ++it)
+    {
+        auto p = it.get().begin().get();
+        auto q = it.get().end().get();
+        perimeter += sqrt(pow(q[0] - p[0], 2) + pow(q[1] - p[1], 2));
+        partialArea += p[0] * q[1] - p[1] * q[0];
+        lastPoint = q;
+    }
+
+    perimeter += sqrt(pow(firstPoint[0] - lastPoint[0], 2) + pow(firstPoint[1] - lastPoint[1], 2));
+    partialArea += lastPoint[0] * firstPoint[1] - lastPoint[1] * firstPoint[0];
+    double area = abs(partialArea) * 0.5;
+    double circularity = (4 * M_PI * area) / (perimeter * perimeter);
+
+    cout << perimeter;
+    cout << ';';
+    cout << circularity;
+    cout << ';';
+}
+
+// Solidity of a component: its area over the area of the convex hull of its pixel squares.
+// A single grain is close to convex, two touching grains leave concavities at their contact.
+double solidity(const vector<Point> &points)
+{
+    // corners of the pixel squares, sorted for the monotone chain
+    vector<Point> corners;
+    for (auto &p : points)
+    {
+        corners.push_back(p);
+        corners.push_back(p + Point(1, 0));
+        corners.push_back(p + Point(0, 1));
+        corners.push_back(p + Point(1, 1));
+    }
+    sort(corners.begin(), corners.end(), [](const Point &p, const Point &q) {
+        return p[0] < q[0] || (p[0] == q[0] && p[1] < q[1]);
+    });
+    auto cross = [](const Point &a, const Point &b, const Point &c) {
+        return (double)(b[0] - a[0]) * (c[1] - a[1]) - (double)(b[1] - a[1]) * (c[0] - a[0]);
+    };
+    vector<Point> hull(2 * corners.size());
+    size_t k = 0;
+    for (size_t i = 0; i < corners.size(); i++)
+    {
+        while (k >= 2 && cross(hull[k - 2], hull[k - 1], corners[i]) <= 0)
+            k--;
+        hull[k++] = corners[i];
+    }
+    for (size_t i = corners.size() - 1, t = k + 1; i > 0; i--)
+    {
+        while (k >= t && cross(hull[k - 2], hull[k - 1], corners[i - 1]) <= 0)
+            k--;
+        hull[k++] = corners[i - 1];
+    }
+
+    double hullArea = 0;
+    for (size_t i = 0; i + 1 < k; i++)
+        hullArea += (double)hull[i][0] * hull[i + 1][1] - (double)hull[i][1] * hull[i + 1][0];
+    return points.size() / (abs(hullArea) * 0.5);
+}
+
+// Split one component with a watershed on its chamfer (3,4) distance transform.
+// Pixels are flooded from the highest distance down, growing basins with the adjacency of
+// the object foreground (4 for (4,8), 8 for (8,4)). When two basins meet, the lower one is
+// merged into the other unless its dynamic (peak minus the meeting level) reaches minDynamic
+// and its area reaches minArea, so plateaus and ridges do not make extra grains.
+// Every returned grain is a single component of the same kind as the input.
+vector<vector<Point>> watershed(const vector<Point> &points, bool is4_8, int minDynamic, int minArea)
+{
+    // local grid around the component, with a background frame of one pixel
+    Point lower = points[0];
+    Point upper = points[0];
+    for (auto &p : points)
+    {
+        lower = lower.inf(p);
+        upper = upper.sup(p);
+    }
+    const int width = upper[0] - lower[0] + 3;
+    const int height = upper[1] - lower[1] + 3;
+    const int INF = numeric_limits<int>::max() / 2;
+    vector<int> dist(width * height, 0);
+    vector<int> order;
+    for (auto &p : points)
+    {
+        order.push_back((p[1] - lower[1] + 1) * width + (p[0] - lower[0] + 1));
+        dist[order.back()] = INF;
+    }
+
+    // chamfer (3,4) distance to the background, forward then backward pass
+    for (int y = 1; y < height - 1; y++)
+        for (int x = 1; x < width - 1; x++)
+        {
+            int &d = dist[y * width + x];
+            if (d == 0)
+                continue;
+            d = min(d, dist[(y - 1) * width + x - 1] + 4);
+            d = min(d, dist[(y - 1) * width + x] + 3);
+            d = min(d, dist[(y - 1) * width + x + 1] + 4);
+            d = min(d, dist[y * width + x - 1] + 3);
+        }
+    for (int y = height - 2; y >= 1; y--)
+        for (int x = width - 2; x >= 1; x--)
+        {
+            int &d = dist[y * width + x];
+            if (d == 0)
+                continue;
+            d = min(d, dist[(y + 1) * width + x + 1] + 4);
+            d = min(d, dist[(y + 1) * width + x] + 3);
+            d = min(d, dist[(y + 1) * width + x - 1] + 4);
+            d = min(d, dist[y * width + x + 1] + 3);
+        }
+
+    // neighbours in the adjacency of the foreground
+    vector<int> neighbours = {-1, 1, -width, width};
+    if (!is4_8)
+        neighbours.insert(neighbours.end(), {-width - 1, -width + 1, width - 1, width + 1});
+
+    // basins as a union-find, with the peak and the area of each root
+    vector<int> parent(width * height, -1);
+    vector<int> peak(width * height, 0);
+    vector<int> area(width * height, 0);
+    auto find = [&](int i) {
+        while (parent[i] != i)
+            i = parent[i] = parent[parent[i]];
+        return i;
+    };
+
+    // flooding, highest distance first
+    stable_sort(order.begin(), order.end(), [&](int i, int j) { return dist[i] > dist[j]; });
+    for (int i : order)
+    {
+        int basin = -1;
+        for (int n : neighbours)
+        {
+            int k = i + n;
+            if (parent[k] < 0)
+                continue;
+            int r = find(k);
+            if (basin < 0 || r == basin)
+            {
+                basin = r;
+                continue;
+            }
+            // two basins meet at level dist[i]: the lower one survives only if it is deep and big enough
+            int high = peak[r] > peak[basin] ? r : basin;
+            int low = high == r ? basin : r;
+            if (peak[low] - dist[i] < minDynamic || area[low] < minArea)
+            {
+                parent[low] = high;
+                area[high] += area[low];
+            }
+            basin = high;
+        }
+        if (basin < 0)
+        {
+            // a new maximum
+            parent[i] = i;
+            peak[i] = dist[i];
+            area[i] = 1;
+        }
+        else
+        {
+            parent[i] = basin;
+            area[basin]++;
+        }
+    }
+
+    // one grain per remaining basin
+    vector<int> label(width * height, -1);
+    vector<vector<Point>> grains;
+    for (auto &p : points)
+    {
+        int r = find((p[1] - lower[1] + 1) * width + (p[0] - lower[0] + 1));
+        if (label[r] < 0)
+        {
+            label[r] = grains.size();
+            grains.push_back(vector<Point>());
+        }
+        grains[label[r]].push_back(p);
+    }
+    return grains;
+}
+
+// Flag the oversize or non convex components and split them, one component per task.
+template <class T>
+vector<T> splitGrains(vector<T> &objects, bool is4_8, int minDynamic)
+{
+    vector<double> areas;
+    for (auto &o : objects)
+        areas.push_back(o.size());
+    vector<double> sorted = areas;
+    sort(sorted.begin(), sorted.end());
+    double median = sorted.empty() ? 0 : sorted[sorted.size() / 2];
+
+    const int minArea = MIN_AREA_RATIO * median;
+
+    // each worker takes the next component until there is none left
+    vector<vector<vector<Point>>> results(objects.size());
+    atomic<unsigned int> next(0);
+    auto worker = [&]() {
+        for (unsigned int i = next++; i < objects.size(); i = next++)
+        {
+            vector<Point> points(objects[i].pointSet().begin(), objects[i].pointSet().end());
+            if (areas[i] > OVERSIZE_FACTOR * median || solidity(points) < MIN_SOLIDITY)
+                results[i] = watershed(points, is4_8, minDynamic, minArea);
+            else
+                results[i].push_back(points);
+        }
+    };
+    unsigned int nbThreads = max(1u, thread::hardware_concurrency());
+    vector<thread> threads;
+    for (unsigned int t = 0; t < nbThreads; t++)
+        threads.push_back(thread(worker));
+    for (auto &t : threads)
+        t.join();
+
+    // rebuild one digital object per grain
+    vector<T> grains;
+    for (unsigned int i = 0; i < objects.size(); i++)
+    {
+        for (auto &points : results[i])
+        {
+            DigitalSet grainSet(objects[i].domain());
+            for (auto &p : points)
+                grainSet.insertNew(p);
+            grains.push_back(T(objects[i].topology(), grainSet));
+        }
+    }
+    return grains;
+}
+
+template <class T>
+bool isInside(T &o, bool is4_8, int xLimit, int yLimit)
+{
+    Curve c = boundary(o, is4_8);
+    for (auto &p : c)
+    {
+        PointVector<2, Integer> point = p.preCell().coordinates;
+        if (point[0] <= 0 || point[0] >= xLimit || point[1] <= 0 || point[1] >= yLimit)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+
+    if (argc < 2)
+    {
+        cout << "Please give me the picture name as argument" << endl;
+        return 0;
+    }
+    // optional minimal dynamic of a grain
+    int minDynamic = argc > 2 ? atoi(argv[2]) : MIN_DYNAMIC;
+
+    // read an image
+    const string filestart = "../RiceGrains/Rice_";
+    const string filename(argv[1]);
+    const string fileend = "_seg_bin.pgm";
+    ImageType image = PGMReader<ImageType>::importPGM(filestart + argv[1] + fileend);
+
+    // digital set
+    DigitalSet set2d(image.domain());
+    SetFromImage<DigitalSet>::append<ImageType>(set2d, image, 1, 255);
+
+    // vector of digital object
+    // (4,8) adjacency
+    vector<ObjectType48> objects48;
+    back_insert_iterator<vector<ObjectType48>> inserter48(objects48);
+    // (8,4) adjacency
+    vector<ObjectType84> objects84;
+    back_insert_iterator<vector<ObjectType84>> inserter84(objects84);
+
+    // connected components
+    // (4,8) adjacency
+    ObjectType48 bdiamond48(dt4_8, set2d);
+    bdiamond48.writeComponents(inserter48);
+    // (8,4) adjacency
+    ObjectType84 bdiamond84(dt8_4, set2d);
+    bdiamond84.writeComponents(inserter84);
+
+    // split touching grains
+    vector<ObjectType48> grains48 = splitGrains(objects48, true, minDynamic);
+    vector<ObjectType84> grains84 = splitGrains(objects84, false, minDynamic);
+
+    // Find limits
+    int xLimit = image.domain().upperBound()[0] * 2;
+    int yLimit = image.domain().upperBound()[1] * 2;
+    Domain domain = image.domain();
+
+    int before4_8 = 0;
+    int before8_4 = 0;
+    for (auto &o : objects48)
+        if (isInside(o, true, xLimit, yLimit))
+            before4_8++;
+    for (auto &o : objects84)
+        if (isInside(o, false, xLimit, yLimit))
+            before8_4++;
+
+    int count4_8 = 0;
+    int count8_4 = 0;
+    for (auto &o : grains84)
+        if (isInside(o, false, xLimit, yLimit))
+            count8_4++;
+
+    Board2D aBoard;
+    cout << "Perimètre 1;Circularité 1;Perimètre 2;Circularité 2;" << endl;
+    for (auto &o : grains48)
+    {
+        if (!isInside(o, true, xLimit, yLimit))
+            continue;
+        count4_8++;
+
+        Curve c = boundary(o, true);
+        aBoard << c;
+        double circularity = (4 * M_PI * o.size()) / (c.size() * c.size());
+        cout << c.size();
+        cout << ';';
+        cout << circularity;
+        cout << ';';
+        segmentation(o, domain);
+        cout << endl;
+    }
+
+    cout << "Nombre de grains de riz 4_8 avant/après séparation: " << endl;
+    cout << before4_8 << " / " << count4_8 << endl;
+    cout << "Nombre de grains de riz 8_4 avant/après séparation: " << endl;
+    cout << before8_4 << " / " << count8_4 << endl;
+
+    aBoard.saveCairo(("pdf/boundaryCurve_" + string(argv[1]) + "_Watershed.pdf").c_str(), Board2D::CairoPDF);
+    return 0;
+}